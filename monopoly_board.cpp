@@ -1,9 +1,360 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
+
+#ifdef MONOPOLY_BOARD_INSTRUMENTATION
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#endif
 
 using namespace std;
 
+#ifdef MONOPOLY_BOARD_INSTRUMENTATION
+
+constexpr size_t sitesPerBlock = 64; // Call site counters are allocated this many at a time
+constexpr size_t maxSiteBlocks = 64; // Call sites past 4096 are counted as dropped in the JSON
+constexpr size_t latencyBuckets = 48; // Bucket i counts calls taking less than 2^i nanoseconds
+constexpr size_t traceEventsPerBlock = 4096; // Trace events are allocated this many at a time
+constexpr size_t maxTraceBlocks = 64; // Stop tracing a thread past 262144 events to bound memory
+
+// Counter written by a single thread and read by the exporter without a lock
+class RelaxedCounter {
+private:
+    atomic<long long> value{0};
+
+public:
+    void add(const long long amount) {
+        value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+
+    [[nodiscard]] long long get() const {
+        return value.load(memory_order_relaxed);
+    }
+};
+
+// Statistics collected by one thread for a single instrumented call site
+struct SiteCounters {
+    RelaxedCounter calls;
+    RelaxedCounter nodesVisited;
+    RelaxedCounter allocations;
+    RelaxedCounter totalNs;
+    array<RelaxedCounter, latencyBuckets> latencyHistogram;
+};
+
+// A completed call recorded for the Chrome trace
+struct TraceEvent {
+    size_t site;
+    long long startNs;
+    long long durationNs;
+};
+
+// Counters for a block of consecutive call sites
+struct SiteBlock {
+    array<SiteCounters, sitesPerBlock> sites;
+};
+
+// Counters and trace of a single thread, only written by that thread
+// Blocks are allocated as the thread first needs them, so memory follows what it actually records
+class ThreadStats {
+private:
+    array<atomic<SiteBlock *>, maxSiteBlocks> siteBlocks{};
+    array<atomic<TraceEvent *>, maxTraceBlocks> traceBlocks{};
+    atomic<size_t> traceSize{0}; // Events published to the exporter
+
+public:
+    size_t threadId = 0; // Small sequential id used as the trace tid
+    RelaxedCounter droppedTraceEvents; // Calls not traced because the trace was full
+
+    ThreadStats() = default;
+
+    ThreadStats(const ThreadStats &) = delete;
+
+    ThreadStats &operator=(const ThreadStats &) = delete;
+
+    ~ThreadStats() {
+        for (atomic<SiteBlock *> &block: siteBlocks) {
+            delete block.load();
+        }
+        for (atomic<TraceEvent *> &block: traceBlocks) {
+            delete[] block.load();
+        }
+    }
+
+    // Get the counters of a call site for the owning thread, or `nullptr` if the site is past the limit
+    SiteCounters *counters(const size_t site) {
+        const size_t index = site / sitesPerBlock;
+        if (index >= maxSiteBlocks) {
+            return nullptr;
+        }
+
+        SiteBlock *block = siteBlocks[index].load(memory_order_relaxed);
+        if (block == nullptr) {
+            block = new SiteBlock();
+            siteBlocks[index].store(block, memory_order_release);
+        }
+        return &block->sites[site % sitesPerBlock];
+    }
+
+    // Get the counters of a call site for the exporter, or `nullptr` if the thread never recorded it
+    [[nodiscard]] const SiteCounters *find(const size_t site) const {
+        const size_t index = site / sitesPerBlock;
+        if (index >= maxSiteBlocks) {
+            return nullptr;
+        }
+
+        const SiteBlock *block = siteBlocks[index].load(memory_order_acquire);
+        return block == nullptr ? nullptr : &block->sites[site % sitesPerBlock];
+    }
+
+    // Append a trace event for the owning thread, publishing it only after it is fully written
+    void trace(const TraceEvent &event) {
+        const size_t size = traceSize.load(memory_order_relaxed);
+        const size_t index = size / traceEventsPerBlock;
+        if (index >= maxTraceBlocks) {
+            droppedTraceEvents.add(1);
+            return;
+        }
+
+        TraceEvent *block = traceBlocks[index].load(memory_order_relaxed);
+        if (block == nullptr) {
+            block = new TraceEvent[traceEventsPerBlock];
+            traceBlocks[index].store(block, memory_order_release);
+        }
+        block[size % traceEventsPerBlock] = event;
+        traceSize.store(size + 1, memory_order_release);
+    }
+
+    // Get the number of trace events published to the exporter
+    [[nodiscard]] size_t traceCount() const {
+        return traceSize.load(memory_order_acquire);
+    }
+
+    // Get a published trace event for the exporter
+    [[nodiscard]] const TraceEvent &traceEvent(const size_t i) const {
+        return traceBlocks[i / traceEventsPerBlock].load(memory_order_acquire)[i % traceEventsPerBlock];
+    }
+};
+
+// Process wide registry of instrumented call sites and per-thread statistics
+class Instrumentation {
+private:
+    mutex lock; // Only taken to register sites and threads and to export
+    vector<const char *> siteNames;
+    vector<unique_ptr<ThreadStats> > threads; // Kept after their thread exits so its counts are still exported
+    const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+public:
+    static Instrumentation &instance() {
+        static Instrumentation collector;
+        return collector;
+    }
+
+    // Nanoseconds elapsed since the collector was created
+    [[nodiscard]] long long now() const {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+    }
+
+    // Give a call site its slot in every thread's counters
+    size_t registerSite(const char *name) {
+        lock_guard<mutex> guard(lock);
+        siteNames.push_back(name);
+        return siteNames.size() - 1;
+    }
+
+    // Get the statistics of the calling thread, registering them on first use
+    ThreadStats &threadStats() {
+        thread_local ThreadStats *stats = nullptr;
+        if (stats == nullptr) {
+            lock_guard<mutex> guard(lock);
+            threads.push_back(make_unique<ThreadStats>());
+            stats = threads.back().get();
+            stats->threadId = threads.size();
+        }
+        return *stats;
+    }
+
+    // Write per-operation counters and latency histograms, merged over every thread, as JSON
+    void writeJson(const string &path) {
+        lock_guard<mutex> guard(lock);
+
+        // Merge the counters of every thread by operation name
+        struct Totals {
+            long long calls = 0;
+            long long nodesVisited = 0;
+            long long allocations = 0;
+            long long totalNs = 0;
+            array<long long, latencyBuckets> latencyHistogram{};
+        };
+        map<string, Totals> totals;
+        const size_t maxSites = sitesPerBlock * maxSiteBlocks;
+        for (size_t site = 0; site < siteNames.size() && site < maxSites; site++) {
+            Totals &entry = totals[siteNames[site]];
+            for (const unique_ptr<ThreadStats> &stats: threads) {
+                const SiteCounters *found = stats->find(site);
+                if (found == nullptr) {
+                    continue;
+                }
+                const SiteCounters &counters = *found;
+                entry.calls += counters.calls.get();
+                entry.nodesVisited += counters.nodesVisited.get();
+                entry.allocations += counters.allocations.get();
+                entry.totalNs += counters.totalNs.get();
+                for (size_t i = 0; i < latencyBuckets; i++) {
+                    entry.latencyHistogram[i] += counters.latencyHistogram[i].get();
+                }
+            }
+        }
+
+        // Report anything that wasn't recorded so missing data can't go unnoticed
+        const size_t droppedSites = siteNames.size() > maxSites ? siteNames.size() - maxSites : 0;
+        long long droppedTraceEvents = 0;
+        for (const unique_ptr<ThreadStats> &stats: threads) {
+            droppedTraceEvents += stats->droppedTraceEvents.get();
+        }
+
+        ofstream out(path);
+        out << "{\"droppedSites\": " << droppedSites << ", \"droppedTraceEvents\": " << droppedTraceEvents
+                << ", \"operations\": {";
+        bool first = true;
+        for (const auto &[name, entry]: totals) {
+            out << (first ? "" : ",") << "\n  \"" << name << "\": {\"calls\": " << entry.calls
+                    << ", \"nodesVisited\": " << entry.nodesVisited << ", \"allocations\": " << entry.allocations
+                    << ", \"totalNs\": " << entry.totalNs << ", \"latencyHistogramNs\": [";
+            bool firstBucket = true;
+            for (size_t i = 0; i < latencyBuckets; i++) {
+                if (entry.latencyHistogram[i] == 0) {
+                    continue;
+                }
+                out << (firstBucket ? "" : ", ") << "{\"lessThan\": " << (1LL << i) << ", \"count\": "
+                        << entry.latencyHistogram[i] << "}";
+                firstBucket = false;
+            }
+            out << "]}";
+            first = false;
+        }
+        out << "\n}}\n";
+    }
+
+    // Write every traced call in the Chrome trace event format (chrome://tracing or Perfetto)
+    void writeChromeTrace(const string &path) {
+        lock_guard<mutex> guard(lock);
+        ofstream out(path);
+        out << fixed << setprecision(3); // Timestamps are microseconds with nanosecond precision
+        out << "{\"traceEvents\": [";
+        bool first = true;
+        for (const unique_ptr<ThreadStats> &stats: threads) {
+            const size_t size = stats->traceCount();
+            for (size_t i = 0; i < size; i++) {
+                const TraceEvent &event = stats->traceEvent(i);
+                out << (first ? "" : ",") << "\n  {\"name\": \"" << siteNames[event.site]
+                        << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << stats->threadId
+                        << ", \"ts\": " << event.startNs / 1000.0 << ", \"dur\": " << event.durationNs / 1000.0
+                        << "}";
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+    }
+};
+
+// An instrumented call site, registered once the first time it runs
+struct OperationSite {
+    const size_t index;
+
+    explicit OperationSite(const char *name) : index(Instrumentation::instance().registerSite(name)) {
+    }
+};
+
+// Times one call to an operation and counts the nodes it visits and allocates
+class ScopedOperation {
+private:
+    const OperationSite &site;
+    ThreadStats &stats;
+    long long startNs;
+    long long visited = 0;
+    long long allocations = 0;
+    ScopedOperation *parent; // Enclosing operation on this thread, if any
+
+    static ScopedOperation *&current() {
+        thread_local ScopedOperation *operation = nullptr;
+        return operation;
+    }
+
+public:
+    explicit ScopedOperation(const OperationSite &site) : site(site),
+                                                         stats(Instrumentation::instance().threadStats()),
+                                                         startNs(Instrumentation::instance().now()),
+                                                         parent(current()) {
+        current() = this;
+    }
+
+    ScopedOperation(const ScopedOperation &) = delete;
+
+    ScopedOperation &operator=(const ScopedOperation &) = delete;
+
+    // Add the call to this thread's counters, without taking any lock
+    ~ScopedOperation() {
+        const long long durationNs = Instrumentation::instance().now() - startNs;
+        current() = parent;
+
+        SiteCounters *found = stats.counters(site.index);
+        if (found == nullptr) {
+            return; // Past the site limit, reported as dropped in the JSON
+        }
+        SiteCounters &counters = *found;
+        counters.calls.add(1);
+        counters.nodesVisited.add(visited);
+        counters.allocations.add(allocations);
+        counters.totalNs.add(durationNs);
+        const size_t bucket = bit_width(static_cast<unsigned long long>(durationNs));
+        counters.latencyHistogram[min(bucket, latencyBuckets - 1)].add(1);
+
+        stats.trace({site.index, startNs, durationNs});
+    }
+
+    // Count a node visited by the innermost running operation
+    static void visit() {
+        if (current() != nullptr) {
+            current()->visited++;
+        }
+    }
+
+    // Count a node allocated by the innermost running operation
+    static void allocate() {
+        if (current() != nullptr) {
+            current()->allocations++;
+        }
+    }
+};
+
+#define INSTRUMENT_OPERATION(name) \
+    static const OperationSite instrumentedSite(name); \
+    ScopedOperation instrumentedOperation(instrumentedSite)
+#define INSTRUMENT_VISIT() ScopedOperation::visit()
+#define INSTRUMENT_ALLOCATION() ScopedOperation::allocate()
+#else
+// Instrumentation compiles away entirely unless MONOPOLY_BOARD_INSTRUMENTATION is defined
+#define INSTRUMENT_OPERATION(name)
+#define INSTRUMENT_VISIT()
+#define INSTRUMENT_ALLOCATION()
+#endif
+
 // Data class to store a string and an integer
 class MonopolyBoard {
 public:
@@ -79,7 +430,205 @@ class CircularLinkedList {
 private:
     Node<T> *headNode;
 
+    // Kinds of changes recorded in the undo journal
+    enum class JournalOp { Link, Data, Allocate, Release };
+
+    // A single reversible change made to the list while a snapshot is active
+    struct JournalEntry {
+        JournalOp op;
+        Node<T> **link; // Pointer that was overwritten (a nextNode field or the headNode)
+        Node<T> *node; // Previous link target, or the node whose data or lifetime changed
+    };
+
+    // Where an active snapshot starts in the journal
+    struct SnapshotStart {
+        size_t generation; // Unique id of the snapshot
+        size_t position; // Journal size when the snapshot was taken
+    };
+
+    vector<JournalEntry> journal; // Changes made since the outermost active snapshot
+    vector<T> savedData; // Previous node data, one per Data entry in the journal
+    vector<SnapshotStart> snapshots; // Active snapshots from outermost to innermost
+    size_t nextGeneration = 0; // Id given to the next snapshot, never reused
+    bool journaling = false; // Record changes only while a snapshot is active
+
+    // Overwrite a link, remembering its old target if a snapshot is active
+    void setLink(Node<T> *&link, Node<T> *target) {
+        if (journaling) {
+            journal.push_back({JournalOp::Link, &link, link});
+        }
+        link = target;
+    }
+
+    // Overwrite the data of a node, remembering its old data if a snapshot is active
+    void setData(Node<T> *node, const T &value) {
+        if (journaling) {
+            journal.push_back({JournalOp::Data, nullptr, node});
+            savedData.push_back(node->data);
+        }
+        node->data = value;
+    }
+
+    // Allocate a new node; its own links don't need journaling as rollback frees it
+    Node<T> *allocateNode(T value) {
+        auto *newNode = new Node<T>(value); // Allocate memory for a new node
+        INSTRUMENT_ALLOCATION();
+        if (journaling) {
+            journal.push_back({JournalOp::Allocate, nullptr, newNode});
+        }
+        return newNode;
+    }
+
+    // Free an unlinked node, or keep it alive until commit if a snapshot may still restore it
+    void releaseNode(Node<T> *node) {
+        if (journaling) {
+            journal.push_back({JournalOp::Release, nullptr, node});
+            return;
+        }
+        delete node;
+    }
+
+    // Undo journal entries from newest to oldest until the journal is back to a given size
+    void undoJournal(const size_t position) {
+        while (journal.size() > position) {
+            const JournalEntry &entry = journal.back();
+            switch (entry.op) {
+                case JournalOp::Link:
+                    *entry.link = entry.node; // Restore the old link target
+                    break;
+                case JournalOp::Data:
+                    entry.node->data = std::move(savedData.back()); // Restore the old node data
+                    savedData.pop_back();
+                    break;
+                case JournalOp::Allocate:
+                    delete entry.node; // Node is no longer linked, free it
+                    break;
+                case JournalOp::Release:
+                    break; // Node is linked back in by the older link entries
+            }
+            journal.pop_back();
+        }
+    }
+
+    // End every snapshot from a depth inward, and stop recording once none are left
+    void endSnapshots(const size_t depth) {
+        snapshots.resize(depth);
+        if (!snapshots.empty()) {
+            return;
+        }
+
+        // Free the nodes deleted while snapshots were active
+        for (const JournalEntry &entry: journal) {
+            if (entry.op == JournalOp::Release) {
+                delete entry.node;
+            }
+        }
+        journal.clear();
+        savedData.clear();
+        journaling = false;
+    }
+
+    static constexpr size_t linearBatchSize = 8; // Batches up to this size are searched one key at a time
+
+    // Match a batch of keys against the nodes in a single traversal, keeping the first match of each key
+    template<typename Key, typename KeyOf, typename Matches>
+    vector<Node<T> *> searchBatch(span<const Key> keys, const KeyOf &keyOf, Matches matches) {
+        vector<Node<T> *> found(keys.size(), nullptr);
+        if (isListEmpty() || keys.empty()) {
+            return found;
+        }
+
+        // Small batches cost less as one `search` style traversal per key than the per-node bookkeeping below
+        if (keys.size() <= linearBatchSize) {
+            for (size_t i = 0; i < keys.size(); i++) {
+                Node<T> *temp = headNode;
+                do {
+                    if (matches(temp->data, keys[i])) {
+                        found[i] = temp;
+                        break;
+                    }
+                    temp = temp->nextNode;
+                    INSTRUMENT_VISIT();
+                } while (temp != headNode);
+            }
+            return found;
+        }
+
+        // Sort the indices of the keys so each node only compares against the keys ordered equal to it
+        vector<size_t> pending(keys.size());
+        iota(pending.begin(), pending.end(), 0);
+        stable_sort(pending.begin(), pending.end(), [&keys](const size_t lhs, const size_t rhs) {
+            return keys[lhs] < keys[rhs];
+        });
+        size_t remaining = keys.size();
+
+        // Traverse through the circular linked list until every key is found
+        Node<T> *temp = headNode;
+        do {
+            Node<T> *next = temp->nextNode;
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(next); // Start loading the next node while comparing the current one
+#endif
+            const auto &nodeKey = keyOf(temp->data);
+            auto first = lower_bound(pending.begin(), pending.end(), nodeKey,
+                                     [&keys](const size_t index, const auto &key) {
+                                         return keys[index] < key;
+                                     });
+            auto last = upper_bound(first, pending.end(), nodeKey,
+                                    [&keys](const auto &key, const size_t index) {
+                                        return key < keys[index];
+                                    });
+
+            // Keep the first match in list order, like `search` does
+            for (auto it = first; it != last; ++it) {
+                if (found[*it] == nullptr && matches(temp->data, keys[*it])) {
+                    found[*it] = temp;
+                    remaining--;
+                }
+            }
+            temp = next;
+            INSTRUMENT_VISIT();
+        } while (temp != headNode && remaining > 0);
+
+        return found;
+    }
+
 public:
+    // Identifies a snapshot returned by `snapshot`
+    struct SnapshotMarker {
+        size_t generation; // Unique id of the snapshot
+        size_t depth; // Nesting depth of the snapshot
+    };
+
+    // Snapshot that rolls the list back when it goes out of scope unless it's kept
+    class ScopedSnapshot {
+    private:
+        CircularLinkedList<T> &list;
+        SnapshotMarker marker;
+
+    public:
+        explicit ScopedSnapshot(CircularLinkedList<T> &list) : list(list), marker(list.snapshot()) {
+        }
+
+        ScopedSnapshot(const ScopedSnapshot &) = delete;
+
+        ScopedSnapshot &operator=(const ScopedSnapshot &) = delete;
+
+        // Roll back unless the snapshot was kept or already ended by an outer rollback or commit
+        ~ScopedSnapshot() {
+            if (list.isSnapshotActive(marker)) {
+                list.rollback(marker);
+            }
+        }
+
+        // Keep the changes made since the snapshot
+        void keep() {
+            if (list.isSnapshotActive(marker)) {
+                list.commit(marker);
+            }
+        }
+    };
+
     CircularLinkedList() {
         headNode = nullptr;
     }
@@ -90,17 +639,19 @@ public:
     * @param value The node to insert.
     */
     void insertAtHead(T value) {
-        auto *newNode = new Node<T>(value); // Allocate memory for a new node
+        INSTRUMENT_OPERATION("insertAtHead");
+
+        Node<T> *newNode = allocateNode(value); // Allocate memory for a new node
 
         if (isListEmpty()) {
-            headNode = newNode; // Update the headNode
-            headNode->nextNode = headNode; // Link the last node back to the head
+            newNode->nextNode = newNode; // Link the last node back to the head
+            setLink(headNode, newNode); // Update the headNode
         } else {
             Node<T> *temp = getLastNode(); // Get the tail node
 
             newNode->nextNode = headNode; // Link the new node's next value to the current head
-            headNode = newNode; // Update the headNode
-            temp->nextNode = headNode; // Link the last node back to the head
+            setLink(headNode, newNode); // Update the headNode
+            setLink(temp->nextNode, headNode); // Link the last node back to the head
         }
     }
 
@@ -110,16 +661,18 @@ public:
     * @param value The node to insert.
     */
     void insertAtTail(T value) {
-        auto *newNode = new Node<T>(value); // Allocate memory for a new node
+        INSTRUMENT_OPERATION("insertAtTail");
+
+        Node<T> *newNode = allocateNode(value); // Allocate memory for a new node
 
         if (isListEmpty()) {
-            headNode = newNode;
-            headNode->nextNode = headNode; // List is now one element, link head back to itself
+            newNode->nextNode = newNode; // List is now one element, link head back to itself
+            setLink(headNode, newNode);
         } else {
             Node<T> *temp = getLastNode(); // Get the tail node
 
-            temp->nextNode = newNode; // Link the previous tail node to the new tail node
             newNode->nextNode = headNode; // Link the tail node back to the head node
+            setLink(temp->nextNode, newNode); // Link the previous tail node to the new tail node
         }
     }
 
@@ -132,6 +685,8 @@ public:
     * @throws invalid_argument Thrown if position is less than 1 or greater than the size of the list
     */
     void insertAtPosition(T value, const int position) {
+        INSTRUMENT_OPERATION("insertAtPosition");
+
         const int size = countNodes(); // Get size of the linked list
 
         if (position < 1 || position > size) {
@@ -149,7 +704,7 @@ public:
         }
 
         int count = 1; // Initialize count to 1
-        auto *newNode = new Node<T>(value); // Allocate memory for the new node
+        Node<T> *newNode = allocateNode(value); // Allocate memory for the new node
 
         // Keep track of current and previous nodes
         Node<T> *temp = headNode;
@@ -159,17 +714,20 @@ public:
         do {
             if (count == position) {
                 newNode->nextNode = temp; // Link the new node to the current node
-                prev->nextNode = newNode; // Link the previous node to the new node
+                setLink(prev->nextNode, newNode); // Link the previous node to the new node
                 return;
             }
             count++;
             prev = temp; // Set previous node to current node
             temp = temp->nextNode; // Set current node to the next node
+            INSTRUMENT_VISIT();
         } while (temp != headNode);
     }
 
     // Delete the node at the head of a circular linked list
     void deleteAtHead() {
+        INSTRUMENT_OPERATION("deleteAtHead");
+
         if (isListEmpty()) {
             cout << "List is empty! Nothing to delete!" << endl;
             return;
@@ -179,18 +737,20 @@ public:
 
         // Handle only one node in list
         if (temp == headNode) {
-            delete headNode;
-            headNode = nullptr; // List is now empty
+            releaseNode(headNode);
+            setLink(headNode, nullptr); // List is now empty
             return;
         }
 
-        temp->nextNode = headNode->nextNode; // Link tail node to head's next node
-        delete headNode; // Delete the head node
-        headNode = temp->nextNode; // Update the head node to the next node
+        setLink(temp->nextNode, headNode->nextNode); // Link tail node to head's next node
+        releaseNode(headNode); // Delete the head node
+        setLink(headNode, temp->nextNode); // Update the head node to the next node
     }
 
     // Delete the node at the tail of a circular linked list
     void deleteAtTail() {
+        INSTRUMENT_OPERATION("deleteAtTail");
+
         if (isListEmpty()) {
             cout << "List is empty! Nothing to delete!" << endl;
             return;
@@ -198,8 +758,8 @@ public:
 
         // Check if the circular linked list only has one node
         if (headNode->nextNode == headNode) {
-            delete headNode;
-            headNode = nullptr;
+            releaseNode(headNode);
+            setLink(headNode, nullptr);
             return;
         }
 
@@ -207,10 +767,11 @@ public:
         // Traverse circular linked list until the node before the last
         while (temp->nextNode->nextNode != headNode) {
             temp = temp->nextNode;
+            INSTRUMENT_VISIT();
         }
 
-        delete temp->nextNode; // Delete last node and deallocate memory
-        temp->nextNode = headNode; // Link the new last node back to the head
+        releaseNode(temp->nextNode); // Delete last node and deallocate memory
+        setLink(temp->nextNode, headNode); // Link the new last node back to the head
     }
 
     /**
@@ -221,6 +782,8 @@ public:
     * @throws invalid_argument Thrown if position is less than 1 or greater than the size of the list.
     */
     void deleteAtPosition(const int position) {
+        INSTRUMENT_OPERATION("deleteAtPosition");
+
         if (isListEmpty()) {
             cout << "List is empty! Nothing to delete!" << endl;
             return;
@@ -251,14 +814,15 @@ public:
         // Traverse the circular linked list
         do {
             if (count == position) {
-                prev->nextNode = temp->nextNode;
+                setLink(prev->nextNode, temp->nextNode);
                 // Link the previous node to the node after the node marked for deletion
-                delete temp; // Delete the current node
+                releaseNode(temp); // Delete the current node
                 return;
             }
             count++;
             prev = temp; // Set previous node to current node
             temp = temp->nextNode; // Set current node to the next node
+            INSTRUMENT_VISIT();
         } while (temp != headNode);
     }
 
@@ -271,6 +835,8 @@ public:
     * @return The node found in the search or `nullptr` if not found
     */
     Node<T> *search(T value, const bool print = false) {
+        INSTRUMENT_OPERATION("search");
+
         Node<T> *temp = headNode;
         int position = 1;
 
@@ -286,6 +852,7 @@ public:
             }
             // Update positions for next iteration
             temp = temp->nextNode;
+            INSTRUMENT_VISIT();
             position++;
         } while (temp != headNode);
 
@@ -295,6 +862,46 @@ public:
         return nullptr;
     }
 
+    /**
+    * Search a circular linked list for many nodes in a single traversal.
+    * Gives the same result as calling `search` on each value, but walks the list at most once.
+    * Values are matched through `operator<`, so values that are equal must also compare equivalent.
+    *
+    * @param values The nodes to search for.
+    *
+    * @return The node found for each value in input order, or `nullptr` for values not found.
+    */
+    vector<Node<T> *> searchMany(span<const T> values) {
+        INSTRUMENT_OPERATION("searchMany");
+
+        return searchBatch(values, [](const T &data) -> const T & {
+            return data;
+        }, [](const T &data, const T &value) {
+            return data.isEqual(value);
+        });
+    }
+
+    /**
+    * Search a circular linked list for many keys, such as property names, in a single traversal.
+    * Each key is matched to the first node, in list order, whose extracted key is equal to it.
+    *
+    * @param keys The keys to search for, in any contiguous container such as a `vector<string>`.
+    * @param keyOf Returns the key of a node's data, e.g. a reference to its property name.
+    *
+    * @return The node found for each key in input order, or `nullptr` for keys not found.
+    * @overload
+    */
+    template<ranges::contiguous_range Keys, typename KeyOf>
+    vector<Node<T> *> searchMany(const Keys &keys, KeyOf keyOf) {
+        INSTRUMENT_OPERATION("searchMany(key)");
+
+        using Key = ranges::range_value_t<Keys>;
+        return searchBatch(span<const Key>(ranges::data(keys), ranges::size(keys)), keyOf,
+                           [&keyOf](const T &data, const Key &key) {
+                               return keyOf(data) == key;
+                           });
+    }
+
     /**
     * Displays the nodes in a linked list.
     *
@@ -332,6 +939,8 @@ public:
 
     // Reverse the nodes in a circular linked list
     void reverseCLList() {
+        INSTRUMENT_OPERATION("reverseCLList");
+
         // To reverse the list we need to know the current and previous nodes
         Node<T> *curr = headNode;
         Node<T> *prev = nullptr;
@@ -339,17 +948,20 @@ public:
         // Traverse through the circular linked list
         do {
             Node<T> *next = curr->nextNode; // Keep track of the original next node
-            curr->nextNode = prev; // Reverse the next node position
+            setLink(curr->nextNode, prev); // Reverse the next node position
             prev = curr; // Set the previous node to the current node
             curr = next; // Update the current node to the original next node
+            INSTRUMENT_VISIT();
         } while (curr != headNode); // Break loop if reached end of list
 
-        headNode->nextNode = prev; // Link the last node back to the start
-        headNode = prev; // Update the headNode
+        setLink(headNode->nextNode, prev); // Link the last node back to the start
+        setLink(headNode, prev); // Update the headNode
     }
 
     // Sort a circular linked list using Bubble Sort
     void sortCLList() {
+        INSTRUMENT_OPERATION("sortCLList");
+
         // Don't sort if the list is empty or only has one node
         if (isListEmpty() || headNode->nextNode == headNode) {
             return;
@@ -369,11 +981,12 @@ public:
                 if (curr->data > curr->nextNode->data) {
                     // Swap data between current and next node
                     auto temp = curr->data;
-                    curr->data = curr->nextNode->data;
-                    curr->nextNode->data = temp;
+                    setData(curr, curr->nextNode->data);
+                    setData(curr->nextNode, temp);
                     swapped = true;
                 }
                 curr = curr->nextNode; // Set the current node to the next node
+                INSTRUMENT_VISIT();
             }
             end = curr; // Shorten the sorted portion of the list
         } while (swapped);
@@ -414,6 +1027,8 @@ public:
 
     // Count the amount of nodes in a circular linked list
     int countNodes() {
+        INSTRUMENT_OPERATION("countNodes");
+
         if (isListEmpty()) {
             return 0;
         }
@@ -424,6 +1039,7 @@ public:
         // Traverse through the circular linked list
         do {
             temp = temp->nextNode; // update temp pointer to next node
+            INSTRUMENT_VISIT();
             count++; // Increment the count
         } while (temp != headNode);
 
@@ -432,10 +1048,13 @@ public:
 
     // Extra function to return the last node of a circular linked list
     Node<T> *getLastNode() {
+        INSTRUMENT_OPERATION("getLastNode");
+
         Node<T> *temp = headNode;
 
         while (temp->nextNode != headNode) {
             temp = temp->nextNode;
+            INSTRUMENT_VISIT();
         }
 
         return temp;
@@ -443,12 +1062,15 @@ public:
 
     // Extra function to return the middle node of a circular linked list
     Node<T> *getMiddle() {
+        INSTRUMENT_OPERATION("getMiddle");
+
         Node<T> *fast = headNode;
         Node<T> *slow = headNode;
 
         do {
             slow = slow->nextNode;
             fast = fast->nextNode->nextNode;
+            INSTRUMENT_VISIT();
         } while (fast != headNode && fast->nextNode != headNode);
 
         return slow;
@@ -456,12 +1078,14 @@ public:
 
     // Method to de-circularize a list
     void convertCLList() {
+        INSTRUMENT_OPERATION("convertCLList");
+
         if (isListEmpty()) {
             return;
         }
 
         Node<T> *tail = getLastNode(); // Get the tail node
-        tail->nextNode = nullptr; // Link the tail node to NULL
+        setLink(tail->nextNode, nullptr); // Link the tail node to NULL
     }
 
     /**
@@ -471,18 +1095,76 @@ public:
     * @param update The node containing updated data.
     */
     void updateNodeValue(T value, T update) {
+        INSTRUMENT_OPERATION("updateNodeValue(value)");
+
         if (isListEmpty()) {
             cout << "List is empty! Can't update node value!" << endl;
             return;
         }
 
+        if (!tryUpdateNodeValue(value, update)) {
+            cout << "Node not found on the board! Nothing to update!" << endl;
+        }
+    }
+
+    /**
+    * Update the data of a specific node in a circular linked list without printing any message.
+    *
+    * @param value The node whose data needs to be updated in the list.
+    * @param update The node containing updated data.
+    *
+    * @return `true` if the node was found and updated or `false` if it isn't in the list.
+    */
+    bool tryUpdateNodeValue(const T &value, const T &update) {
+        INSTRUMENT_OPERATION("tryUpdateNodeValue");
+
+        if (isListEmpty()) {
+            return false;
+        }
+
         // Search the list for the node
         Node<T> *searchNode = search(value);
         if (searchNode == nullptr) {
-            cout << "Node not found on the board! Nothing to update!" << endl;
-            return;
+            return false;
         }
-        searchNode->data = update; // Update the node data
+        setData(searchNode, update); // Update the node data
+        return true;
+    }
+
+    /**
+    * Update a node through a chain of values in a single traversal without printing any message.
+    * Only applies the chain when it gives the same result as calling `tryUpdateNodeValue` for each step in order,
+    * i.e. when no node before the first match holds one of the intermediate values.
+    *
+    * @param values The node's current data followed by each successive update.
+    *
+    * @return `true` if the node was updated to the last value or `false` if nothing was changed.
+    */
+    bool tryUpdateNodeChain(span<const T> values) {
+        INSTRUMENT_OPERATION("tryUpdateNodeChain");
+
+        if (isListEmpty() || values.size() < 2) {
+            return false;
+        }
+
+        Node<T> *temp = headNode;
+        do {
+            if (temp->data.isEqual(values.front())) {
+                setData(temp, values.back()); // Update the data to the end of the chain
+                return true;
+            }
+
+            // An earlier node holding an intermediate value would be picked by one of the steps instead
+            for (size_t i = 1; i + 1 < values.size(); i++) {
+                if (temp->data.isEqual(values[i])) {
+                    return false;
+                }
+            }
+            temp = temp->nextNode;
+            INSTRUMENT_VISIT();
+        } while (temp != headNode);
+
+        return false;
     }
 
     /**
@@ -495,6 +1177,8 @@ public:
     * @overload
     */
     void updateNodeValue(int position, T update) {
+        INSTRUMENT_OPERATION("updateNodeValue(position)");
+
         if (isListEmpty()) {
             cout << "List is empty! Nothing to update!" << endl;
             return;
@@ -511,17 +1195,20 @@ public:
         do {
             // Check if indicated position is reached
             if (position == count) {
-                temp->data = update; // Update the data
+                setData(temp, update); // Update the data
                 return;
             }
             // Increment positions and counters
             count++;
             temp = temp->nextNode;
+            INSTRUMENT_VISIT();
         } while (temp != headNode);
     }
 
     // Display all nodes with a certain color
     void displaySpecificColorNode(string color) {
+        INSTRUMENT_OPERATION("displaySpecificColorNode");
+
         if (isListEmpty()) {
             return;
         }
@@ -541,6 +1228,7 @@ public:
                 match = true;
             }
             temp = temp->nextNode; // Update temp pointer to the next node
+            INSTRUMENT_VISIT();
         } while (temp != headNode);
 
         // Text displayed if no nodes contained the property color
@@ -551,32 +1239,833 @@ public:
 
     // Merge two circular linked lists
     void mergeCLList(const CircularLinkedList<T> &other) {
+        INSTRUMENT_OPERATION("mergeCLList");
+
         if (other.headNode == nullptr) {
             return;
         }
 
         if (isListEmpty()) {
-            headNode = other.headNode;
+            setLink(headNode, other.headNode);
             return;
         }
 
-        // Copy second list to a new list to avoid altering it
-        auto new_list = new CircularLinkedList<T>;
+        // Copy the nodes of the second list to avoid altering it
+        Node<T> *copyHead = nullptr;
+        Node<T> *copyTail = nullptr;
         Node<T> *temp = other.headNode;
         do {
-            new_list->insertAtTail(temp->data); // Insert the nodes into new list
+            Node<T> *newNode = allocateNode(temp->data);
+            if (copyHead == nullptr) {
+                copyHead = newNode;
+            } else {
+                copyTail->nextNode = newNode; // Link the copy after the previous copy
+            }
+            copyTail = newNode;
             temp = temp->nextNode;
+            INSTRUMENT_VISIT();
         } while (temp != other.headNode);
 
-        // Get the tail of both lists
-        Node<T> *tail = getLastNode();
-        Node<T> *tail2 = new_list->getLastNode();
+        Node<T> *tail = getLastNode(); // Get the tail of the first list
+
+        copyTail->nextNode = headNode; // Link the tail of the copy back to the head of the first list
+        setLink(tail->nextNode, copyHead); // Link the tail of the first list to the head of the copy
+    }
+
+    /**
+    * Determine if two circular linked lists hold equal nodes in the same order.
+    *
+    * @param other The list to compare against.
+    *
+    * @return `true` if both lists have the same nodes in the same order or `false` otherwise.
+    */
+    [[nodiscard]] bool isEqual(const CircularLinkedList<T> &other) const {
+        Node<T> *temp = headNode;
+        Node<T> *otherTemp = other.headNode;
+        if (temp == nullptr || otherTemp == nullptr) {
+            return temp == otherTemp;
+        }
+
+        // Traverse both lists together
+        do {
+            if (!temp->data.isEqual(otherTemp->data)) {
+                return false;
+            }
+            temp = temp->nextNode;
+            otherTemp = otherTemp->nextNode;
+        } while (temp != headNode && otherTemp != other.headNode);
 
-        tail->nextNode = new_list->headNode; // Link the tail of the first list to the head of the second list
-        tail2->nextNode = headNode; // Link the tail of the second list back to the head of the first list
+        return temp == headNode && otherTemp == other.headNode; // Both lists must end together
     }
+
+    /**
+    * Copy every node of a circular linked list into a new list.
+    *
+    * @return A list with its own copies of the nodes, in the same order.
+    */
+    CircularLinkedList<T> clone() const {
+        INSTRUMENT_OPERATION("clone");
+
+        CircularLinkedList<T> copy;
+        if (headNode == nullptr) {
+            return copy;
+        }
+
+        // Keep track of the tail so each copy is linked in O(1)
+        Node<T> *tail = nullptr;
+        Node<T> *temp = headNode;
+        do {
+            auto *newNode = new Node<T>(temp->data);
+            INSTRUMENT_ALLOCATION();
+            if (tail == nullptr) {
+                copy.headNode = newNode;
+            } else {
+                tail->nextNode = newNode;
+            }
+            tail = newNode;
+            temp = temp->nextNode;
+            INSTRUMENT_VISIT();
+        } while (temp != headNode);
+
+        tail->nextNode = copy.headNode; // Link the tail back to the head
+        return copy;
+    }
+
+    // Delete every node of a circular linked list
+    void clear() {
+        INSTRUMENT_OPERATION("clear");
+
+        if (isListEmpty()) {
+            return;
+        }
+
+        Node<T> *temp = headNode;
+        do {
+            Node<T> *next = temp->nextNode; // Keep track of the next node before deleting the current one
+            releaseNode(temp);
+            temp = next;
+            INSTRUMENT_VISIT();
+        } while (temp != headNode);
+
+        setLink(headNode, nullptr); // List is now empty
+    }
+
+    /**
+    * Take a snapshot of the list so later changes can be rolled back.
+    * Snapshots nest: a snapshot stays active until it, or a snapshot it is nested in, is rolled back or committed.
+    *
+    * @return A marker to pass to `rollback` or `commit` to end the snapshot.
+    */
+    SnapshotMarker snapshot() {
+        journaling = true; // Start recording changes
+        snapshots.push_back({nextGeneration, journal.size()});
+        return {nextGeneration++, snapshots.size() - 1};
+    }
+
+    /**
+    * Determine if a snapshot can still be rolled back or committed.
+    *
+    * @param marker The value returned by `snapshot`.
+    *
+    * @return `true` if the snapshot is active or `false` if it has ended.
+    */
+    [[nodiscard]] bool isSnapshotActive(const SnapshotMarker &marker) const {
+        return marker.depth < snapshots.size() && snapshots[marker.depth].generation == marker.generation;
+    }
+
+    /**
+    * Undo every change made since a snapshot was taken and end it, along with the snapshots nested in it.
+    * Costs time proportional to the number of changes made, not the size of the list.
+    *
+    * @param marker The value returned by `snapshot`.
+    *
+    * @throws invalid_argument Thrown if marker does not belong to an active snapshot.
+    */
+    void rollback(const SnapshotMarker &marker) {
+        INSTRUMENT_OPERATION("rollback");
+
+        if (!isSnapshotActive(marker)) {
+            throw invalid_argument("Marker does not belong to an active snapshot!");
+        }
+
+        undoJournal(snapshots[marker.depth].position);
+        endSnapshots(marker.depth);
+    }
+
+    /**
+    * Keep every change made since a snapshot was taken and end it, along with the snapshots nested in it.
+    * The changes can still be rolled back by an outer snapshot.
+    *
+    * @param marker The value returned by `snapshot`.
+    *
+    * @throws invalid_argument Thrown if marker does not belong to an active snapshot.
+    */
+    void commit(const SnapshotMarker &marker) {
+        INSTRUMENT_OPERATION("commit");
+
+        if (!isSnapshotActive(marker)) {
+            throw invalid_argument("Marker does not belong to an active snapshot!");
+        }
+
+        endSnapshots(marker.depth);
+    }
+
+    // Keep every change made since the outermost snapshot and stop recording
+    void commit() {
+        INSTRUMENT_OPERATION("commit");
+
+        endSnapshots(0);
+    }
+
+    /**
+    * Get the number of changes recorded since the outermost active snapshot.
+    *
+    * @return The size of the undo journal.
+    */
+    [[nodiscard]] size_t journalSize() const {
+        return journal.size();
+    }
+};
+
+// Kinds of board mutations accepted by the event pipeline
+enum class BoardEventType { Insert, Delete, Update };
+
+// A single board mutation waiting to be applied (buy = Insert, sell = Delete, rent change or trade = Update)
+template<typename T>
+struct BoardEvent {
+    BoardEventType type;
+    T value; // Node to insert, or node to update
+    T update; // Updated node data for Update events
+    int position; // 1-based position for Insert and Delete events
+    chrono::steady_clock::time_point enqueued; // Set when the event enters the queue
+
+    static BoardEvent insert(T value, const int position) {
+        return {BoardEventType::Insert, std::move(value), T(), position, {}};
+    }
+
+    static BoardEvent remove(const int position) {
+        return {BoardEventType::Delete, T(), T(), position, {}};
+    }
+
+    static BoardEvent change(T value, T update) {
+        return {BoardEventType::Update, std::move(value), std::move(update), 0, {}};
+    }
+};
+
+// Fixed size latency histogram with 8 buckets per power of two, so percentiles are within 12.5% of the true value
+class LatencyHistogram {
+private:
+    static constexpr int subBucketBits = 3; // 2^3 buckets per power of two
+    static constexpr size_t subBuckets = 1 << subBucketBits;
+    array<long long, 64 * subBuckets> counts{}; // Enough buckets for any non-negative 64-bit value
+    long long total = 0;
+    long long maximum = 0;
+
+    // Values below 8 get their own bucket, larger ones are split by their top 4 bits
+    static size_t bucketOf(const unsigned long long ns) {
+        if (ns < subBuckets) {
+            return ns;
+        }
+        const int exponent = bit_width(ns) - 1;
+        const size_t sub = (ns >> (exponent - subBucketBits)) & (subBuckets - 1);
+        return (static_cast<size_t>(exponent - subBucketBits + 1) << subBucketBits) + sub;
+    }
+
+    // Largest value that falls into a bucket
+    static long long upperBoundOf(const size_t bucket) {
+        if (bucket < subBuckets) {
+            return static_cast<long long>(bucket);
+        }
+        const int exponent = static_cast<int>(bucket >> subBucketBits) + subBucketBits - 1;
+        const unsigned long long sub = bucket & (subBuckets - 1);
+        return static_cast<long long>(((subBuckets + sub + 1) << (exponent - subBucketBits)) - 1);
+    }
+
+public:
+    void record(const long long ns) {
+        const long long value = max(ns, 0LL);
+        counts[bucketOf(value)]++;
+        total++;
+        maximum = max(maximum, value);
+    }
+
+    /**
+    * Estimate a percentile of the recorded latencies.
+    *
+    * @param fraction The percentile as a fraction, e.g. 0.99 for p99.
+    *
+    * @return The upper bound of the bucket holding the percentile, or 0 if nothing was recorded.
+    */
+    [[nodiscard]] long long percentile(const double fraction) const {
+        if (total == 0) {
+            return 0;
+        }
+
+        const auto rank = max(1LL, static_cast<long long>(fraction * static_cast<double>(total) + 0.999999));
+        long long seen = 0;
+        for (size_t bucket = 0; bucket < counts.size(); bucket++) {
+            seen += counts[bucket];
+            if (seen >= rank) {
+                return min(upperBoundOf(bucket), maximum);
+            }
+        }
+        return maximum;
+    }
+
+    [[nodiscard]] long long maxValue() const {
+        return maximum;
+    }
+};
+
+// Snapshot of the counters kept by a BoardEventPipeline
+struct PipelineMetrics {
+    long long enqueued = 0; // Events accepted into the queue
+    long long applied = 0; // Events applied to the board successfully, including coalesced ones
+    long long coalesced = 0; // Updates merged into an earlier update of the same property
+    long long failed = 0; // Events the board couldn't apply, e.g. missing properties or positions out of range
+    long long batches = 0; // Batches applied to the board
+    long long blockedPushes = 0; // Pushes that had to wait for room in the queue
+    long long rejectedPushes = 0; // Calls to tryPush refused because the queue was full
+    size_t queueDepth = 0; // Events currently waiting
+    size_t maxQueueDepth = 0; // Deepest the queue has been
+    long long p50LatencyNs = 0; // Median time from enqueue to applied
+    long long p99LatencyNs = 0; // 99th percentile time from enqueue to applied
+    long long maxLatencyNs = 0; // Slowest time from enqueue to applied
 };
 
+// Applies a stream of board events from many producers on a single applier thread
+template<typename T>
+class BoardEventPipeline {
+private:
+    CircularLinkedList<T> &board;
+    const size_t capacity; // Producers wait once this many events are queued
+    const size_t maxBatch; // Most events applied per batch
+
+    deque<BoardEvent<T> > queue;
+    mutex lock;
+    condition_variable notEmpty;
+    condition_variable notFull;
+    bool stopping = false;
+    PipelineMetrics counters;
+    LatencyHistogram latencies; // Time from enqueue to applied for every event
+    thread applier; // Declared last so every other member is ready when it starts
+
+    // Wait for events and apply them in batches until stopped and drained
+    void run() {
+        vector<BoardEvent<T> > batch;
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                notEmpty.wait(guard, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return; // Stopping and nothing left to apply
+                }
+
+                // Take up to a full batch and let blocked producers continue
+                const size_t count = min(maxBatch, queue.size());
+                batch.assign(make_move_iterator(queue.begin()), make_move_iterator(queue.begin() + count));
+                queue.erase(queue.begin(), queue.begin() + count);
+            }
+            notFull.notify_all();
+
+            applyBatch(batch);
+        }
+    }
+
+    // A batch entry: a single event, or updates of the same node merged into one chain
+    struct MergedEvent {
+        vector<size_t> events; // Indices in the batch of the events the entry stands for
+        vector<T> chain; // For updates, the data the node goes through: the first value, then every update
+    };
+
+    /**
+    * Find the pending update an update event can be chained onto without changing the result.
+    *
+    * @return The index of the entry in merged, or `merged.size()` if the event must stay on its own.
+    */
+    static size_t findChainTarget(const vector<MergedEvent> &merged, const multimap<T, size_t> &pendingUpdates,
+                                  const map<T, size_t> &lastTouched, const BoardEvent<T> &event) {
+        // Only chain onto an update whose result no other pending update also produces
+        size_t target = merged.size();
+        int matches = 0;
+        auto [first, last] = pendingUpdates.equal_range(event.value);
+        for (auto it = first; it != last; ++it) {
+            if (merged[it->second].chain.back().isEqual(event.value)) {
+                target = it->second;
+                matches++;
+            }
+        }
+        if (matches != 1) {
+            return merged.size();
+        }
+
+        // Moving the event up to the chain must not reorder it with a later update that may touch the same data
+        for (const T *data: {&event.value, &event.update}) {
+            auto touched = lastTouched.find(*data);
+            if (touched != lastTouched.end() && touched->second > target) {
+                return merged.size();
+            }
+        }
+        return target;
+    }
+
+    // Coalesce and apply a batch of events, then record how long each waited
+    void applyBatch(const vector<BoardEvent<T> > &batch) {
+        INSTRUMENT_OPERATION("applyBatch");
+
+        vector<MergedEvent> merged;
+        multimap<T, size_t> pendingUpdates; // Latest data of each pending update -> its entry in merged
+        map<T, size_t> lastTouched; // Data in pending chains, grouped by operator< -> last entry in merged with it
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            const BoardEvent<T> &event = batch[i];
+            if (event.type != BoardEventType::Update) {
+                pendingUpdates.clear(); // Positions shift, so later updates can't merge across this event
+                lastTouched.clear();
+                merged.push_back({{i}, {}});
+                continue;
+            }
+
+            const size_t target = findChainTarget(merged, pendingUpdates, lastTouched, event);
+            if (target == merged.size()) {
+                pendingUpdates.emplace(event.update, merged.size());
+                lastTouched.insert_or_assign(event.value, merged.size());
+                lastTouched.insert_or_assign(event.update, merged.size());
+                merged.push_back({{i}, {event.value, event.update}});
+                continue;
+            }
+
+            // Extend the chain and re-key it by its new final data
+            auto [first, last] = pendingUpdates.equal_range(event.value);
+            for (auto it = first; it != last; ++it) {
+                if (it->second == target) {
+                    pendingUpdates.erase(it);
+                    break;
+                }
+            }
+            merged[target].events.push_back(i);
+            merged[target].chain.push_back(event.update);
+            pendingUpdates.emplace(event.update, target);
+            lastTouched.insert_or_assign(event.update, target);
+        }
+
+        long long failed = 0;
+        long long coalesced = 0;
+        for (const MergedEvent &entry: merged) {
+            if (entry.events.size() > 1) {
+                if (board.tryUpdateNodeChain(entry.chain)) {
+                    coalesced += static_cast<long long>(entry.events.size()) - 1;
+                    continue;
+                }
+                // Fall back to the original events so the board ends up as if they were applied one at a time
+            }
+            for (const size_t index: entry.events) {
+                if (!applyEvent(batch[index])) {
+                    failed++;
+                }
+            }
+        }
+
+        // Every event in the batch is applied once the batch is done
+        const auto appliedAt = chrono::steady_clock::now();
+        lock_guard<mutex> guard(lock);
+        for (const BoardEvent<T> &event: batch) {
+            latencies.record(chrono::duration_cast<chrono::nanoseconds>(appliedAt - event.enqueued).count());
+        }
+        counters.applied += static_cast<long long>(batch.size()) - failed;
+        counters.coalesced += coalesced;
+        counters.failed += failed;
+        counters.batches++;
+    }
+
+    // Apply a single event to the board, without printing anything
+    bool applyEvent(const BoardEvent<T> &event) {
+        try {
+            switch (event.type) {
+                case BoardEventType::Insert:
+                    board.insertAtPosition(event.value, event.position);
+                    return true;
+                case BoardEventType::Delete:
+                    if (board.isListEmpty()) {
+                        return false; // deleteAtPosition would only print a message
+                    }
+                    board.deleteAtPosition(event.position);
+                    return true;
+                case BoardEventType::Update:
+                    return board.tryUpdateNodeValue(event.value, event.update);
+            }
+        } catch (const invalid_argument &) {
+            // Position out of range
+        }
+        return false;
+    }
+
+    // Add an event to the queue, the lock must be held and the queue must have room
+    void enqueue(BoardEvent<T> event) {
+        event.enqueued = chrono::steady_clock::now();
+        queue.push_back(std::move(event));
+        counters.enqueued++;
+        counters.maxQueueDepth = max(counters.maxQueueDepth, queue.size());
+    }
+
+public:
+    /**
+    * Start the applier thread for a board.
+    * The board must not be used elsewhere until the pipeline is stopped.
+    *
+    * @param board The board the events are applied to.
+    * @param capacity The number of queued events at which producers are held back.
+    * @param maxBatch The most events coalesced and applied together.
+    *
+    * @throws invalid_argument Thrown if capacity or maxBatch is 0.
+    */
+    explicit BoardEventPipeline(CircularLinkedList<T> &board, const size_t capacity = 1024,
+                                const size_t maxBatch = 256) : board(board), capacity(capacity), maxBatch(maxBatch) {
+        if (capacity == 0 || maxBatch == 0) {
+            throw invalid_argument("Capacity and batch size must be greater than 0!");
+        }
+        applier = thread(&BoardEventPipeline::run, this);
+    }
+
+    BoardEventPipeline(const BoardEventPipeline &) = delete;
+
+    BoardEventPipeline &operator=(const BoardEventPipeline &) = delete;
+
+    ~BoardEventPipeline() {
+        stop();
+    }
+
+    /**
+    * Queue an event, waiting for room if the queue is full.
+    *
+    * @param event The board mutation to apply.
+    *
+    * @throws logic_error Thrown if the pipeline has been stopped.
+    */
+    void push(BoardEvent<T> event) {
+        unique_lock<mutex> guard(lock);
+        if (!stopping && queue.size() >= capacity) {
+            counters.blockedPushes++;
+            notFull.wait(guard, [this] { return stopping || queue.size() < capacity; });
+        }
+        if (stopping) {
+            throw logic_error("Can't push events to a stopped pipeline!");
+        }
+        enqueue(std::move(event));
+        guard.unlock();
+        notEmpty.notify_one();
+    }
+
+    /**
+    * Queue an event only if there is room for it.
+    *
+    * @param event The board mutation to apply.
+    *
+    * @return `true` if the event was queued or `false` if the queue was full or the pipeline stopped.
+    */
+    bool tryPush(BoardEvent<T> event) {
+        unique_lock<mutex> guard(lock);
+        if (stopping || queue.size() >= capacity) {
+            counters.rejectedPushes++;
+            return false;
+        }
+        enqueue(std::move(event));
+        guard.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Apply every queued event and stop the applier thread
+    void stop() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+        if (applier.joinable()) {
+            applier.join();
+        }
+    }
+
+    /**
+    * Get the queue and latency counters collected so far.
+    *
+    * @return A copy of the counters with latency percentiles estimated from every processed event.
+    */
+    PipelineMetrics metrics() {
+        lock_guard<mutex> guard(lock);
+        PipelineMetrics result = counters;
+        result.queueDepth = queue.size();
+
+        result.p50LatencyNs = latencies.percentile(0.5);
+        result.p99LatencyNs = latencies.percentile(0.99);
+        result.maxLatencyNs = latencies.maxValue();
+        return result;
+    }
+};
+
+// Build a full 40 square board with distinct property names
+vector<MonopolyBoard> makeBoardProperties(const int size = 40) {
+    vector<MonopolyBoard> properties;
+    for (int i = 0; i < size; i++) {
+        properties.emplace_back("Property " + to_string(i), "Color " + to_string(i % 8), 60 + 10 * i, 2 + i);
+    }
+    return properties;
+}
+
+// Apply one of three lookahead moves (rent change, purchase or trade) to a board
+void applyLookaheadMove(CircularLinkedList<MonopolyBoard> &board, const int move, const int depth) {
+    const int position = 1 + (depth * 7) % (board.countNodes() - 1);
+    switch (move) {
+        case 0: // Rent change
+            board.updateNodeValue(position, MonopolyBoard("Upgraded " + to_string(depth), "Color", 200, 50 + depth));
+            break;
+        case 1: // Purchase
+            board.insertAtPosition(MonopolyBoard("Bought " + to_string(depth), "Color", 150, 20), position);
+            break;
+        default: // Trade
+            board.deleteAtPosition(position);
+            break;
+    }
+}
+
+// Explore the move tree by deep copying the board at every node
+long long searchWithCopies(CircularLinkedList<MonopolyBoard> &board, const int depth) {
+    if (depth == 0) {
+        return board.countNodes();
+    }
+
+    long long visited = 0;
+    for (int move = 0; move < 3; move++) {
+        CircularLinkedList<MonopolyBoard> child = board.clone();
+        applyLookaheadMove(child, move, depth);
+        visited += searchWithCopies(child, depth - 1);
+        child.clear(); // Free the copy before trying the next move
+    }
+    return visited;
+}
+
+// Explore the move tree on a single board, rolling back each move with the undo journal
+long long searchWithSnapshots(CircularLinkedList<MonopolyBoard> &board, const int depth) {
+    if (depth == 0) {
+        return board.countNodes();
+    }
+
+    long long visited = 0;
+    for (int move = 0; move < 3; move++) {
+        CircularLinkedList<MonopolyBoard>::ScopedSnapshot snapshot(board); // Rolled back at the end of the move
+        applyLookaheadMove(board, move, depth);
+        visited += searchWithSnapshots(board, depth - 1);
+    }
+    return visited;
+}
+
+// Compare deep copies against snapshots for a depth 6 lookahead search
+void benchmarkLookahead() {
+    constexpr int depth = 6;
+    const vector<MonopolyBoard> properties = makeBoardProperties();
+
+    CircularLinkedList<MonopolyBoard> board;
+    for (const MonopolyBoard &property: properties) {
+        board.insertAtTail(property);
+    }
+
+    auto start = chrono::steady_clock::now();
+    const long long copyResult = searchWithCopies(board, depth);
+    const auto copyTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+
+    start = chrono::steady_clock::now();
+    const long long snapshotResult = searchWithSnapshots(board, depth);
+    const auto snapshotTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+
+    // The board must be back to its original state with nothing left in the journal
+    bool restored = board.countNodes() == static_cast<int>(properties.size()) && board.journalSize() == 0;
+    for (const MonopolyBoard &property: properties) {
+        restored = restored && board.search(property) != nullptr;
+    }
+
+    cout << "Depth " << depth << " lookahead over " << properties.size() << " properties:" << endl;
+    cout << "Deep copies: " << copyTime.count() << " us" << endl;
+    cout << "Snapshots: " << snapshotTime.count() << " us" << endl;
+    cout << "Same leaves visited: " << (copyResult == snapshotResult ? "yes" : "no") << endl;
+    cout << "Board restored: " << (restored ? "yes" : "no") << endl;
+
+    board.clear();
+}
+
+// Compare one search per property against a single batched search for growing batch sizes
+void benchmarkSearchMany() {
+    constexpr int boardSize = 1000;
+    constexpr int lookupsPerMeasurement = 1 << 16; // Repeat each batch until this many lookups are timed
+    const vector<MonopolyBoard> properties = makeBoardProperties(boardSize);
+
+    CircularLinkedList<MonopolyBoard> board;
+    for (const MonopolyBoard &property: properties) {
+        board.insertAtTail(property);
+    }
+
+    // Time a lookup routine over enough repetitions to report nanoseconds per lookup
+    auto nsPerLookup = [](const int batchSize, auto &&lookup) {
+        const int repetitions = max(1, lookupsPerMeasurement / batchSize);
+        const auto start = chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; i++) {
+            lookup();
+        }
+        const auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        return elapsed.count() / (static_cast<long long>(repetitions) * batchSize);
+    };
+
+    for (const int batchSize: {1, 8, 64, 512}) {
+        // Spread the lookups over the board and include some properties that aren't on it
+        vector<MonopolyBoard> keys;
+        vector<string> names;
+        for (int i = 0; i < batchSize; i++) {
+            if (i % 8 == 7) {
+                keys.emplace_back("Missing " + to_string(i), "Color", 0, 0);
+            } else {
+                keys.push_back(properties[(i * 37 + 500) % boardSize]);
+            }
+            names.push_back(keys.back().propertyName);
+        }
+        auto nameOf = [](const MonopolyBoard &property) -> const string & {
+            return property.propertyName;
+        };
+
+        vector<Node<MonopolyBoard> *> expected;
+        vector<Node<MonopolyBoard> *> batched;
+        vector<Node<MonopolyBoard> *> byName;
+
+        const long long searchNs = nsPerLookup(batchSize, [&] {
+            expected.clear();
+            for (const MonopolyBoard &key: keys) {
+                expected.push_back(board.search(key));
+            }
+        });
+        const long long batchNs = nsPerLookup(batchSize, [&] {
+            batched = board.searchMany(keys);
+        });
+        const long long nameNs = nsPerLookup(batchSize, [&] {
+            byName = board.searchMany(names, nameOf);
+        });
+
+        cout << "Batch of " << batchSize << " over " << boardSize << " properties: search " << searchNs
+                << " ns/lookup, searchMany " << batchNs << " ns/lookup, by name " << nameNs
+                << " ns/lookup, identical: " << (batched == expected && byName == expected ? "yes" : "no") << endl;
+    }
+
+    board.clear();
+}
+
+// Stream rent changes from several producer threads through the event pipeline
+void benchmarkEventPipeline(const size_t capacity) {
+    constexpr int producers = 4;
+    constexpr int eventsPerProducer = 50000;
+    const vector<MonopolyBoard> properties = makeBoardProperties();
+
+    CircularLinkedList<MonopolyBoard> board;
+    for (const MonopolyBoard &property: properties) {
+        board.insertAtTail(property);
+    }
+
+    // Each producer owns its own properties so every rent change is based on the latest data
+    vector<vector<MonopolyBoard> > owned(producers);
+    for (size_t i = 0; i < properties.size(); i++) {
+        owned[i % producers].push_back(properties[i]);
+    }
+
+    const auto start = chrono::steady_clock::now();
+    PipelineMetrics metrics;
+    {
+        BoardEventPipeline<MonopolyBoard> pipeline(board, capacity);
+        vector<thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&pipeline, &current = owned[p]] {
+                for (int i = 0; i < eventsPerProducer; i++) {
+                    MonopolyBoard &property = current[i % current.size()];
+                    MonopolyBoard changed = property;
+                    changed.rent++;
+                    pipeline.push(BoardEvent<MonopolyBoard>::change(property, changed));
+                    property = changed;
+                }
+            });
+        }
+        for (thread &producer: threads) {
+            producer.join();
+        }
+        pipeline.stop();
+        metrics = pipeline.metrics();
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Every property should hold the last rent its producer sent
+    bool consistent = true;
+    for (const vector<MonopolyBoard> &current: owned) {
+        for (const MonopolyBoard &property: current) {
+            consistent = consistent && board.search(property) != nullptr;
+        }
+    }
+
+    cout << "Queue capacity " << capacity << ": " << static_cast<long long>(metrics.applied / seconds)
+            << " events/sec, p99 latency " << metrics.p99LatencyNs / 1000 << " us" << endl;
+    cout << "Batches: " << metrics.batches << ", coalesced: " << metrics.coalesced << ", blocked pushes: "
+            << metrics.blockedPushes << ", max queue depth: " << metrics.maxQueueDepth << endl;
+    cout << "Board consistent: " << (consistent ? "yes" : "no") << endl;
+
+    board.clear();
+}
+
+// Run updates through the pipeline and one at a time, and check both leave the same board and failure count
+bool coalescingMatchesSequential(const vector<MonopolyBoard> &properties,
+                                 const vector<pair<MonopolyBoard, MonopolyBoard> > &updates) {
+    CircularLinkedList<MonopolyBoard> board;
+    for (const MonopolyBoard &property: properties) {
+        board.insertAtTail(property);
+    }
+
+    CircularLinkedList<MonopolyBoard> expected = board.clone();
+    long long expectedFailed = 0;
+    for (const auto &[value, update]: updates) {
+        expectedFailed += expected.tryUpdateNodeValue(value, update) ? 0 : 1;
+    }
+
+    PipelineMetrics metrics;
+    {
+        BoardEventPipeline<MonopolyBoard> pipeline(board);
+        for (const auto &[value, update]: updates) {
+            pipeline.push(BoardEvent<MonopolyBoard>::change(value, update));
+        }
+        pipeline.stop();
+        metrics = pipeline.metrics();
+    }
+
+    const bool matches = board.isEqual(expected) && metrics.failed == expectedFailed;
+    board.clear();
+    expected.clear();
+    return matches;
+}
+
+// Check chains of updates that can't be coalesced naively still match applying them one at a time
+void checkEventCoalescing() {
+    const MonopolyBoard a10("A", "Red", 100, 10), a11("A", "Red", 100, 11), a12("A", "Red", 100, 12);
+    const MonopolyBoard b("B", "Red", 100, 5), z("Z", "Red", 100, 1);
+    const MonopolyBoard p5("P", "Red", 100, 5), p6("P", "Red", 100, 6);
+    const MonopolyBoard x1("X", "Red", 100, 1), x2("X", "Red", 100, 2), x3("X", "Red", 100, 3);
+    const MonopolyBoard y1("Y", "Red", 100, 1);
+
+    bool matches = true;
+    // A replayed stale update fails, but the update after it still applies
+    matches = matches && coalescingMatchesSequential({b, a11}, {{a10, a11}, {a11, a12}});
+    // An earlier node already holds the intermediate data, so the second update lands on it
+    matches = matches && coalescingMatchesSequential({p5, z}, {{z, p5}, {p5, p6}});
+    // Two pending updates produce the same data, so the third update takes the first in list order
+    matches = matches && coalescingMatchesSequential({x1, y1}, {{y1, x2}, {x1, x2}, {x2, x3}});
+    // A plain chain of updates of the same property
+    matches = matches && coalescingMatchesSequential({b, a10}, {{a10, a11}, {a11, a12}});
+
+    cout << "Coalesced updates match sequential updates: " << (matches ? "yes" : "no") << endl;
+}
+
 // Main function to demonstrate the LinkedList class
 int main() {
     // Create a new circular linked list object
@@ -731,5 +2220,29 @@ int main() {
     list.printList(false); // Print linear linked list
     cout << endl;
 
+    // Roll back moves explored by a lookahead search
+    cout << "Lookahead benchmark:" << endl;
+    benchmarkLookahead();
+    cout << endl;
+
+    // Resolve a batch of property lookups in a single traversal
+    cout << "Batched search benchmark:" << endl;
+    benchmarkSearchMany();
+    cout << endl;
+
+    // Apply a stream of events from several producers
+    cout << "Event pipeline load test:" << endl;
+    benchmarkEventPipeline(64);
+    benchmarkEventPipeline(4096);
+    checkEventCoalescing();
+    cout << endl;
+
+#ifdef MONOPOLY_BOARD_INSTRUMENTATION
+    // Export the counters, histograms and trace collected during the run
+    Instrumentation::instance().writeJson("monopoly_board_stats.json");
+    Instrumentation::instance().writeChromeTrace("monopoly_board_trace.json");
+    cout << "Instrumentation written to monopoly_board_stats.json and monopoly_board_trace.json" << endl;
+#endif
+
     return 0;
 }